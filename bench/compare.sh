@@ -0,0 +1,52 @@
+#!/bin/sh
+# Compares two outputs of bin/bench and fails if any benchmark got slower than the baseline by more than the
+# tolerance, given in percent, or if a benchmark in the baseline is missing from the current run. Lines starting
+# with # are comments.
+# Usage: bench/compare.sh BASELINE CURRENT [TOLERANCE]
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 BASELINE CURRENT [TOLERANCE]" >&2
+    exit 2
+fi
+
+awk -v tolerance="${3:-50}" '
+    FNR == 1 {
+        file++
+    }
+    /^#/ || NF < 2 {
+        next
+    }
+    file == 1 {
+        baseline[$1] = $2
+        order[++count] = $1
+        next
+    }
+    !($1 in baseline) {
+        printf "%-48s %14s %14.1f %9s  new\n", $1, "-", $2, ""
+        next
+    }
+    {
+        seen[$1] = 1
+        change = baseline[$1] > 0 ? ($2 / baseline[$1] - 1) * 100 : 0
+        status = change > tolerance ? "REGRESSION" : "ok"
+        failed += (change > tolerance)
+        printf "%-48s %14.1f %14.1f %+8.1f%%  %s\n", $1, baseline[$1], $2, change, status
+    }
+    END {
+        for (i = 1; i <= count; i++) {
+            if (!(order[i] in seen)) {
+                printf "%-48s %14.1f %14s %9s  MISSING\n", order[i], baseline[order[i]], "-", ""
+                missing++
+            }
+        }
+        if (failed) {
+            printf "%d benchmark%s regressed by more than %s%%\n", failed, (failed > 1 ? "s" : ""), tolerance
+        }
+        if (missing) {
+            printf "%d benchmark%s missing from the current run\n", missing, (missing > 1 ? "s" : "")
+        }
+        if (failed || missing) {
+            exit 1
+        }
+    }
+' "$1" "$2"
@@ -0,0 +1,407 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "kll.h"
+#include "stack.h"
+#include "stack_concurrent.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+typedef void (*benchfn)();
+const benchfn threaded_benches[];
+const size_t threaded_len;
+const benchfn benches[];
+const size_t len;
+
+// Threaded benchmarks depend on the core count of the machine, so --no-threads leaves them out for comparisons
+// against a stored baseline.
+int main(int argc, char* argv[]) {
+    if (argc < 2 || strcmp(argv[1], "--no-threads")) {
+        for (size_t i = 0; i < threaded_len; i++) {
+            threaded_benches[i]();
+        }
+    }
+    for (size_t i = 0; i < len; i++) {
+        benches[i]();
+    }
+}
+
+void bench_concurrent_readers();
+void bench_rwlock_readers();
+void bench_select_median();
+void bench_select_top_k();
+void bench_select_quantile();
+void bench_sets_balanced();
+void bench_sets_skewed();
+void bench_sets_merge_k();
+
+const benchfn threaded_benches[] = {bench_concurrent_readers, bench_rwlock_readers};
+const size_t threaded_len = sizeof(threaded_benches) / sizeof(benchfn);
+
+const benchfn benches[] = {
+    bench_select_median,
+    bench_select_top_k,
+    bench_select_quantile,
+    bench_sets_balanced,
+    bench_sets_skewed,
+    bench_sets_merge_k};
+const size_t len = sizeof(benches) / sizeof(benchfn);
+
+/* helpers */
+double now_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+void report(const char* name, double elapsed, size_t ops) {
+    printf("%-48s %12.1f ns/op\n", name, elapsed / ops);
+    fflush(stdout);
+}
+
+// Single-threaded benchmarks report their fastest repetition, which keeps scheduling noise out of comparisons against
+// the stored baseline.
+double fastest(double best, double elapsed) {
+    return (best == 0 || elapsed < best) ? elapsed : best;
+}
+
+int_stack_t* random_stack(size_t size, unsigned long long seed) {
+    int_stack_t* stack = int_stack_with_capacity(size);
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        int_stack_push(stack, (int)(seed >> 33) % 1000000);
+    }
+    return stack;
+}
+
+int_stack_t* random_set(size_t size, unsigned long long seed) {
+    int_stack_t* stack = random_stack(size, seed);
+    int_stack_sort(stack);
+    int_stack_dedup(stack);
+    return stack;
+}
+
+/* reader scalability */
+#define READER_OPS 64000
+#define READER_SCAN 1024
+
+const size_t reader_counts[] = {1, 2, 4, 8, 16, 32};
+
+typedef struct {
+    int_stack_concurrent_t* concurrent;
+    int_stack_t* stack;
+    pthread_rwlock_t lock;
+    atomic_int done;
+    size_t ops;
+} reader_bench_t;
+
+// The writers keep the stack at READER_SCAN or READER_SCAN + 1 elements until the readers are done, so every reader op
+// scans the same amount of data. Shrinking back to READER_SCAN leaves no spare capacity, so every push reallocates.
+void* concurrent_writer(void* arg) {
+    reader_bench_t* bench = arg;
+    for (int i = 0; !atomic_load_explicit(&bench->done, memory_order_relaxed); i++) {
+        int_stack_concurrent_truncate(bench->concurrent, READER_SCAN);
+        int_stack_concurrent_push(bench->concurrent, i);
+    }
+    return NULL;
+}
+
+void* concurrent_reader(void* arg) {
+    reader_bench_t* bench = arg;
+    size_t reader = int_stack_concurrent_register(bench->concurrent);
+    for (size_t i = 0; i < bench->ops; i++) {
+        int_stack_concurrent_contains(bench->concurrent, reader, -1);
+    }
+    return NULL;
+}
+
+void* rwlock_writer(void* arg) {
+    reader_bench_t* bench = arg;
+    for (int i = 0; !atomic_load_explicit(&bench->done, memory_order_relaxed); i++) {
+        pthread_rwlock_wrlock(&bench->lock);
+        int_stack_t* shrunk = int_stack_slice(bench->stack, 0, READER_SCAN);
+        int_stack_destroy(bench->stack);
+        bench->stack = shrunk;
+        int_stack_push(bench->stack, i);
+        pthread_rwlock_unlock(&bench->lock);
+    }
+    return NULL;
+}
+
+void* rwlock_reader(void* arg) {
+    reader_bench_t* bench = arg;
+    for (size_t i = 0; i < bench->ops; i++) {
+        pthread_rwlock_rdlock(&bench->lock);
+        int_stack_contains(bench->stack, -1);
+        pthread_rwlock_unlock(&bench->lock);
+    }
+    return NULL;
+}
+
+void run_readers(
+    const char* prefix,
+    reader_bench_t* bench,
+    size_t readers,
+    void* (*writer)(void*),
+    void* (*reader)(void*)) {
+    pthread_t writer_thread;
+    pthread_t reader_threads[32];
+    atomic_init(&bench->done, 0);
+    bench->ops = READER_OPS / readers;
+
+    double start = now_ns();
+    pthread_create(&writer_thread, NULL, writer, bench);
+    for (size_t i = 0; i < readers; i++) {
+        pthread_create(&reader_threads[i], NULL, reader, bench);
+    }
+    for (size_t i = 0; i < readers; i++) {
+        pthread_join(reader_threads[i], NULL);
+    }
+    double elapsed = now_ns() - start;
+    atomic_store(&bench->done, 1);
+    pthread_join(writer_thread, NULL);
+
+    char name[64];
+    snprintf(name, sizeof(name), "%s/readers=%zu", prefix, readers);
+    report(name, elapsed, bench->ops * readers);
+}
+
+void bench_concurrent_readers() {
+    for (size_t i = 0; i < sizeof(reader_counts) / sizeof(size_t); i++) {
+        reader_bench_t bench;
+        bench.concurrent = int_stack_concurrent_create(reader_counts[i]);
+        for (int j = 0; j < READER_SCAN; j++) {
+            int_stack_concurrent_push(bench.concurrent, j);
+        }
+        run_readers("concurrent_contains", &bench, reader_counts[i], concurrent_writer, concurrent_reader);
+        int_stack_concurrent_destroy(bench.concurrent);
+    }
+}
+
+void bench_rwlock_readers() {
+    for (size_t i = 0; i < sizeof(reader_counts) / sizeof(size_t); i++) {
+        reader_bench_t bench;
+        bench.stack = int_stack_create();
+        pthread_rwlock_init(&bench.lock, NULL);
+        for (int j = 0; j < READER_SCAN; j++) {
+            int_stack_push(bench.stack, j);
+        }
+        run_readers("rwlock_contains", &bench, reader_counts[i], rwlock_writer, rwlock_reader);
+        pthread_rwlock_destroy(&bench.lock);
+        int_stack_destroy(bench.stack);
+    }
+}
+
+/* selection */
+#define SELECT_SIZE (1 << 20)
+#define SELECT_REPS 5
+#define SELECT_FAST_REPS 50
+
+volatile int sink;
+
+void bench_select_median() {
+    int_stack_t* input = random_stack(SELECT_SIZE, 1);
+
+    double best = 0;
+    for (int i = 0; i < SELECT_REPS; i++) {
+        int_stack_t* stack = int_stack_from(input->buffer, input->size);
+        double start = now_ns();
+        int_stack_sort(stack);
+        sink = int_stack_get(stack, SELECT_SIZE / 2);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(stack);
+    }
+    report("select_median/sort", best, 1);
+
+    best = 0;
+    for (int i = 0; i < SELECT_REPS; i++) {
+        int_stack_t* stack = int_stack_from(input->buffer, input->size);
+        double start = now_ns();
+        sink = int_stack_nth_element(stack, SELECT_SIZE / 2);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(stack);
+    }
+    report("select_median/nth_element", best, 1);
+
+    int_stack_destroy(input);
+}
+
+void bench_select_top_k() {
+    int_stack_t* input = random_stack(SELECT_SIZE, 2);
+
+    double best = 0;
+    for (int i = 0; i < SELECT_REPS; i++) {
+        int_stack_t* stack = int_stack_from(input->buffer, input->size);
+        double start = now_ns();
+        int_stack_sort(stack);
+        int_stack_t* top = int_stack_from(stack->buffer + SELECT_SIZE - 100, 100);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(top);
+        int_stack_destroy(stack);
+    }
+    report("select_top_100/sort", best, 1);
+
+    best = 0;
+    for (int i = 0; i < SELECT_FAST_REPS; i++) {
+        double start = now_ns();
+        int_stack_t* top = int_stack_top_k(input, 100);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(top);
+    }
+    report("select_top_100/top_k", best, 1);
+
+    best = 0;
+    for (int i = 0; i < SELECT_REPS; i++) {
+        int_stack_t* stack = int_stack_from(input->buffer, input->size);
+        double start = now_ns();
+        int_stack_sort(stack);
+        int_stack_truncate(stack, 100);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(stack);
+    }
+    report("select_bottom_100/sort", best, 1);
+
+    best = 0;
+    for (int i = 0; i < SELECT_FAST_REPS; i++) {
+        int_stack_t* stack = int_stack_from(input->buffer, input->size);
+        double start = now_ns();
+        int_stack_partial_sort(stack, 100);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(stack);
+    }
+    report("select_bottom_100/partial_sort", best, 1);
+
+    int_stack_destroy(input);
+}
+
+void bench_select_quantile() {
+    int_stack_t* input = random_stack(SELECT_SIZE, 3);
+
+    double best = 0;
+    for (int i = 0; i < SELECT_REPS; i++) {
+        int_stack_t* stack = int_stack_create();
+        double start = now_ns();
+        for (size_t j = 0; j < input->size; j++) {
+            int_stack_push(stack, int_stack_get(input, j));
+        }
+        int_stack_sort(stack);
+        sink = int_stack_get(stack, SELECT_SIZE / 100 * 99);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(stack);
+    }
+    report("select_p99/push_sort", best, 1);
+
+    best = 0;
+    for (int i = 0; i < SELECT_REPS; i++) {
+        int_kll_t* sketch = int_kll_create(200);
+        double start = now_ns();
+        int_kll_push_stack(sketch, input);
+        sink = int_kll_quantile(sketch, 0.99);
+        best = fastest(best, now_ns() - start);
+        int_kll_destroy(sketch);
+    }
+    report("select_p99/kll_push", best, 1);
+
+    int_stack_destroy(input);
+}
+
+/* sorted set operations */
+#define SET_REPS 20
+
+// The approach being replaced: sort both stacks, then look every value up linearly.
+int_stack_t* naive_intersection(int_stack_t* stack, int_stack_t* other) {
+    int_stack_t* result = int_stack_create();
+    for (size_t i = 0; i < stack->size; i++) {
+        if (int_stack_contains(other, int_stack_get(stack, i))) {
+            int_stack_push(result, int_stack_get(stack, i));
+        }
+    }
+    return result;
+}
+
+void bench_set_ops(const char* prefix, int_stack_t* a, int_stack_t* b, int naive) {
+    char name[64];
+    int_stack_t* (*ops[])(int_stack_t*, int_stack_t*) = {
+        int_stack_intersection, int_stack_union, int_stack_difference, int_stack_merge};
+    const char* names[] = {"intersection", "union", "difference", "merge"};
+
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        double best = 0;
+        for (int j = 0; j < SET_REPS; j++) {
+            double start = now_ns();
+            int_stack_t* result = ops[i](a, b);
+            best = fastest(best, now_ns() - start);
+            int_stack_destroy(result);
+        }
+        snprintf(name, sizeof(name), "%s/%s", prefix, names[i]);
+        report(name, best, 1);
+    }
+
+    if (naive) {
+        double start = now_ns();
+        int_stack_destroy(naive_intersection(a, b));
+        snprintf(name, sizeof(name), "%s/naive_intersection", prefix);
+        report(name, now_ns() - start, 1);
+    }
+}
+
+void bench_sets_balanced() {
+    int_stack_t* a = random_set(1 << 14, 4);
+    int_stack_t* b = random_set(1 << 14, 5);
+    bench_set_ops("sets_balanced_16k", a, b, 1);
+    int_stack_destroy(a);
+    int_stack_destroy(b);
+
+    a = random_set(1 << 20, 6);
+    b = random_set(1 << 20, 7);
+    bench_set_ops("sets_balanced_1m", a, b, 0);
+    int_stack_destroy(a);
+    int_stack_destroy(b);
+}
+
+void bench_sets_skewed() {
+    int_stack_t* a = random_set(1 << 10, 8);
+    int_stack_t* b = random_set(1 << 16, 9);
+    bench_set_ops("sets_skewed_1k_64k", a, b, 1);
+    int_stack_destroy(a);
+    int_stack_destroy(b);
+}
+
+void bench_sets_merge_k() {
+    int_stack_t* stacks[16];
+    for (size_t i = 0; i < 16; i++) {
+        stacks[i] = random_stack(1 << 16, 10 + i);
+        int_stack_sort(stacks[i]);
+    }
+
+    double best = 0;
+    for (int i = 0; i < SET_REPS; i++) {
+        double start = now_ns();
+        int_stack_t* merged = int_stack_merge_k(stacks, 16);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(merged);
+    }
+    report("sets_merge_16x64k/merge_k", best, 1);
+
+    best = 0;
+    for (int i = 0; i < SET_REPS; i++) {
+        double start = now_ns();
+        int_stack_t* merged = int_stack_from(stacks[0]->buffer, stacks[0]->size);
+        for (size_t j = 1; j < 16; j++) {
+            int_stack_t* copy = int_stack_from(stacks[j]->buffer, stacks[j]->size);
+            int_stack_append(merged, copy);
+            int_stack_destroy(copy);
+        }
+        int_stack_sort(merged);
+        best = fastest(best, now_ns() - start);
+        int_stack_destroy(merged);
+    }
+    report("sets_merge_16x64k/append_sort", best, 1);
+
+    for (size_t i = 0; i < 16; i++) {
+        int_stack_destroy(stacks[i]);
+    }
+}
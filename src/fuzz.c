@@ -0,0 +1,477 @@
+// Differential fuzzer for int_stack_t. Each input is decoded into a sequence of operations which are applied to both a
+// stack and a plain array reference model, and the two are compared after every step.
+//
+// libFuzzer: clang -fsanitize=fuzzer,address,undefined src/stack.c src/fuzz.c
+// AFL and standalone: define FUZZ_STANDALONE and pass input files, or no arguments to run random inputs.
+
+#include "stack.h"
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MODEL_MAX 512
+
+// Selection with an explicit depth limit, defined in stack.c. Small limits reach the heapsort fallback.
+int int_stack_introselect(int_stack_t* stack, size_t n, size_t depth);
+
+typedef struct {
+    int values[MODEL_MAX];
+    size_t size;
+} model_t;
+
+typedef struct {
+    const uint8_t* data;
+    size_t size;
+    size_t pos;
+} input_t;
+
+uint8_t input_byte(input_t* input) {
+    return input->pos < input->size ? input->data[input->pos++] : 0;
+}
+
+int input_done(input_t* input) {
+    return input->pos >= input->size;
+}
+
+// Mostly small values so that duplicates and matches are common, with the occasional extreme value.
+int input_value(input_t* input) {
+    uint8_t kind = input_byte(input);
+    if (kind < 224) {
+        return (int)(kind % 32) - 16;
+    }
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value = (value << 8) | input_byte(input);
+    }
+    return (int)value;
+}
+
+size_t input_index(input_t* input, size_t bound) {
+    size_t value = input_byte(input);
+    value = (value << 8) | input_byte(input);
+    return bound ? value % bound : 0;
+}
+
+int model_cmp(const void* a, const void* b) {
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+void model_sort(int* values, size_t size) {
+    qsort(values, size, sizeof(int), model_cmp);
+}
+
+void model_insert(model_t* model, size_t index, int value) {
+    memmove(model->values + index + 1, model->values + index, sizeof(int) * (model->size - index));
+    model->values[index] = value;
+    model->size++;
+}
+
+int model_remove(model_t* model, size_t index) {
+    int value = model->values[index];
+    memmove(model->values + index, model->values + index + 1, sizeof(int) * (model->size - index - 1));
+    model->size--;
+    return value;
+}
+
+void check_equal(int_stack_t* stack, const int* values, size_t size) {
+    assert(stack->size == size);
+    assert(stack->size <= stack->capacity);
+    assert(!size || !memcmp(stack->buffer, values, sizeof(int) * size));
+}
+
+// Checks that the stack holds the same values as the model in any order, then adopts the stack's order.
+void check_permutation(int_stack_t* stack, model_t* model) {
+    assert(stack->size == model->size);
+    int sorted[MODEL_MAX];
+    memcpy(sorted, stack->buffer, sizeof(int) * stack->size);
+    model_sort(sorted, stack->size);
+    model_sort(model->values, model->size);
+    assert(!memcmp(sorted, model->values, sizeof(int) * model->size));
+    memcpy(model->values, stack->buffer, sizeof(int) * stack->size);
+}
+
+int_stack_t* random_other(input_t* input, model_t* other, int sorted) {
+    other->size = input_byte(input) % 64;
+    for (size_t i = 0; i < other->size; i++) {
+        other->values[i] = input_value(input);
+    }
+    if (sorted) {
+        model_sort(other->values, other->size);
+    }
+    return int_stack_from(other->values, other->size);
+}
+
+// Reference set operations over sorted arrays. The result is sorted, and deduplicated unless keep is set.
+size_t model_set(const model_t* a, const model_t* b, int in_a, int in_b, int keep, int* result) {
+    int all[2 * MODEL_MAX];
+    memcpy(all, a->values, sizeof(int) * a->size);
+    memcpy(all + a->size, b->values, sizeof(int) * b->size);
+    model_sort(all, a->size + b->size);
+
+    size_t size = 0;
+    for (size_t i = 0; i < a->size + b->size; i++) {
+        if (!keep && size && result[size - 1] == all[i]) {
+            continue;
+        }
+        int found_a = bsearch(&all[i], a->values, a->size, sizeof(int), model_cmp) != NULL;
+        int found_b = bsearch(&all[i], b->values, b->size, sizeof(int), model_cmp) != NULL;
+        if ((in_a < 0 || found_a == in_a) && (in_b < 0 || found_b == in_b)) {
+            result[size++] = all[i];
+        }
+    }
+    return size;
+}
+
+int fuzz_map(int value) {
+    return value ^ 0x5a5a;
+}
+
+int fuzz_filter(int value) {
+    return value % 3 == 0;
+}
+
+void fuzz_fold(int* acc, int value) {
+    *acc ^= value;
+}
+
+void run(const uint8_t* data, size_t size) {
+    input_t input = {data, size, 0};
+    model_t model = {.size = 0};
+    model_t other;
+    int result[3 * MODEL_MAX];
+    int_stack_t* stack = int_stack_with_capacity(input_byte(&input) % 4);
+
+    while (!input_done(&input)) {
+        uint8_t op = input_byte(&input) % 26;
+        int full = model.size + 64 > MODEL_MAX;
+
+        switch (op) {
+            case 0: {
+                int value = input_value(&input);
+                if (!full) {
+                    int_stack_push(stack, value);
+                    model.values[model.size++] = value;
+                }
+                break;
+            }
+            case 1:
+                if (model.size) {
+                    assert(int_stack_pop(stack) == model.values[--model.size]);
+                }
+                break;
+            case 2:
+                if (model.size) {
+                    size_t index = input_index(&input, model.size);
+                    int value = input_value(&input);
+                    assert(int_stack_get(stack, index) == model.values[index]);
+                    assert(int_stack_first(stack) == model.values[0]);
+                    assert(int_stack_last(stack) == model.values[model.size - 1]);
+                    int_stack_set(stack, index, value);
+                    model.values[index] = value;
+                }
+                break;
+            case 3: {
+                size_t index = input_index(&input, model.size + 1);
+                int value = input_value(&input);
+                if (!full) {
+                    int_stack_insert(stack, index, value);
+                    model_insert(&model, index, value);
+                }
+                break;
+            }
+            case 4:
+                if (model.size) {
+                    size_t index = input_index(&input, model.size);
+                    assert(int_stack_remove(stack, index) == model_remove(&model, index));
+                }
+                break;
+            case 5: {
+                size_t stop = input_index(&input, model.size + 1);
+                size_t start = input_index(&input, stop + 1);
+                int_stack_t* slice = int_stack_slice(stack, start, stop);
+                check_equal(slice, model.values + start, stop - start);
+                int_stack_destroy(slice);
+                break;
+            }
+            case 6: {
+                int_stack_sort(stack);
+                model_sort(model.values, model.size);
+                int value = input_value(&input);
+                size_t index = int_stack_search(stack, value);
+                int* found = bsearch(&value, model.values, model.size, sizeof(int), model_cmp);
+                assert((index == (size_t)-1) == !found);
+                assert(!found || (model.values[index] == value && (index == 0 || model.values[index - 1] < value)));
+                break;
+            }
+            case 7: {
+                int value = input_value(&input);
+                int found = 0;
+                for (size_t i = 0; i < model.size; i++) {
+                    found |= model.values[i] == value;
+                }
+                assert(int_stack_contains(stack, value) == found);
+                break;
+            }
+            case 8:
+                int_stack_reverse(stack);
+                for (size_t i = 0; i < model.size / 2; i++) {
+                    int tmp = model.values[i];
+                    model.values[i] = model.values[model.size - 1 - i];
+                    model.values[model.size - 1 - i] = tmp;
+                }
+                break;
+            case 9:
+            case 10: {
+                size_t amount = input_index(&input, 4 * MODEL_MAX);
+                if (op == 9) {
+                    int_stack_rotate_left(stack, amount);
+                } else {
+                    int_stack_rotate_right(stack, amount);
+                }
+                if (model.size) {
+                    size_t shift = op == 9 ? amount % model.size : (model.size - amount % model.size) % model.size;
+                    memcpy(result, model.values + shift, sizeof(int) * (model.size - shift));
+                    memcpy(result + model.size - shift, model.values, sizeof(int) * shift);
+                    memcpy(model.values, result, sizeof(int) * model.size);
+                }
+                break;
+            }
+            case 11:
+                if (model.size) {
+                    size_t first = input_index(&input, model.size);
+                    size_t second = input_index(&input, model.size);
+                    int_stack_swap(stack, first, second);
+                    int tmp = model.values[first];
+                    model.values[first] = model.values[second];
+                    model.values[second] = tmp;
+                }
+                break;
+            case 12: {
+                int_stack_t* appended = random_other(&input, &other, 0);
+                if (!full) {
+                    int_stack_append(stack, appended);
+                    assert(appended->size == 0);
+                    memcpy(model.values + model.size, other.values, sizeof(int) * other.size);
+                    model.size += other.size;
+                }
+                int_stack_destroy(appended);
+                break;
+            }
+            case 13: {
+                size_t index = input_index(&input, model.size + 1);
+                int_stack_t* split = int_stack_split(stack, index);
+                check_equal(split, model.values + index, model.size - index);
+                model.size = index;
+                int_stack_destroy(split);
+                break;
+            }
+            case 14: {
+                int value = input_value(&input);
+                if (stack->capacity <= MODEL_MAX) {
+                    int_stack_fill(stack, value);
+                    assert(int_stack_is_full(stack));
+                    while (model.size < stack->size) {
+                        model.values[model.size++] = value;
+                    }
+                }
+                break;
+            }
+            case 15: {
+                size_t size = input_index(&input, (full ? model.size : model.size + 64) + 1);
+                int value = input_value(&input);
+                int_stack_resize(stack, size, value);
+                while (model.size < size) {
+                    model.values[model.size++] = value;
+                }
+                model.size = size;
+                break;
+            }
+            case 16:
+                int_stack_map(stack, fuzz_map);
+                for (size_t i = 0; i < model.size; i++) {
+                    model.values[i] = fuzz_map(model.values[i]);
+                }
+                break;
+            case 17: {
+                int_stack_filter(stack, fuzz_filter);
+                size_t size = 0;
+                for (size_t i = 0; i < model.size; i++) {
+                    if (fuzz_filter(model.values[i])) {
+                        model.values[size++] = model.values[i];
+                    }
+                }
+                model.size = size;
+                break;
+            }
+            case 18: {
+                int acc = 0;
+                for (size_t i = 0; i < model.size; i++) {
+                    fuzz_fold(&acc, model.values[i]);
+                }
+                assert(int_stack_fold(stack, 0, fuzz_fold) == acc);
+                int* found = int_stack_find(stack, fuzz_filter);
+                size_t i = 0;
+                while (i < model.size && !fuzz_filter(model.values[i])) {
+                    i++;
+                }
+                assert(found == (i < model.size ? stack->buffer + i : NULL));
+                break;
+            }
+            case 19:
+                if (model.size) {
+                    size_t n = input_index(&input, model.size);
+                    uint8_t depth = input_byte(&input);
+                    // small depths make the heapsort fallback reachable, which random inputs rarely trigger otherwise
+                    int value =
+                        depth < 128 ? int_stack_nth_element(stack, n) : int_stack_introselect(stack, n, depth % 4);
+                    check_permutation(stack, &model);
+                    memcpy(result, model.values, sizeof(int) * model.size);
+                    model_sort(result, model.size);
+                    assert(value == result[n] && model.values[n] == value);
+                    for (size_t i = 0; i < model.size; i++) {
+                        assert(i < n ? model.values[i] <= value : model.values[i] >= value);
+                    }
+                }
+                break;
+            case 20: {
+                // k may run past the size of the stack, up to the largest size_t, in which case every element is selected
+                size_t k = input_byte(&input) == 255 ? (size_t)-1 : input_index(&input, model.size + 65);
+                size_t count = k < model.size ? k : model.size;
+                memcpy(result, model.values, sizeof(int) * model.size);
+                model_sort(result, model.size);
+                int_stack_t* top = int_stack_top_k(stack, k);
+                assert(top->size == count && top->capacity <= (count ? count : 1));
+                for (size_t i = 0; i < count; i++) {
+                    assert(top->buffer[i] == result[model.size - 1 - i]);
+                }
+                int_stack_destroy(top);
+                int_stack_partial_sort(stack, k);
+                check_permutation(stack, &model);
+                assert(!count || !memcmp(model.values, result, sizeof(int) * count));
+                break;
+            }
+            case 21: {
+                size_t count = int_stack_partition(stack, fuzz_filter);
+                check_permutation(stack, &model);
+                for (size_t i = 0; i < model.size; i++) {
+                    assert(!fuzz_filter(model.values[i]) == (i >= count));
+                }
+                break;
+            }
+            case 22: {
+                int_stack_dedup(stack);
+                size_t size = 0;
+                for (size_t i = 0; i < model.size; i++) {
+                    if (!size || model.values[size - 1] != model.values[i]) {
+                        model.values[size++] = model.values[i];
+                    }
+                }
+                model.size = size;
+                break;
+            }
+            case 23: {
+                int_stack_sort(stack);
+                model_sort(model.values, model.size);
+                int_stack_t* operand = random_other(&input, &other, 1);
+                int_stack_t* (*ops[])(int_stack_t*, int_stack_t*) = {
+                    int_stack_merge, int_stack_union, int_stack_intersection, int_stack_difference};
+                int membership[][3] = {{-1, -1, 1}, {-1, -1, 0}, {1, 1, 0}, {1, 0, 0}};
+                for (size_t i = 0; i < 4; i++) {
+                    int_stack_t* combined = ops[i](stack, operand);
+                    size_t size =
+                        model_set(&model, &other, membership[i][0], membership[i][1], membership[i][2], result);
+                    check_equal(combined, result, size);
+                    int_stack_destroy(combined);
+                }
+                int_stack_destroy(operand);
+                break;
+            }
+            case 24: {
+                int_stack_sort(stack);
+                model_sort(model.values, model.size);
+                int_stack_t* first = random_other(&input, &other, 1);
+                int_stack_t* second = int_stack_from(model.values, model.size);
+                int_stack_t* stacks[] = {stack, first, second};
+                size_t count = 1 + input_byte(&input) % 3;
+
+                size_t size = 0;
+                for (size_t i = 0; i < count; i++) {
+                    memcpy(result + size, stacks[i]->buffer, sizeof(int) * stacks[i]->size);
+                    size += stacks[i]->size;
+                }
+                model_sort(result, size);
+                int_stack_t* merged = int_stack_merge_k(stacks, count);
+                check_equal(merged, result, size);
+
+                int_stack_t* united = int_stack_union_k(stacks, 3);
+                check_equal(united, result, model_set(&model, &other, -1, -1, 0, result));
+                int_stack_destroy(merged);
+                int_stack_destroy(united);
+                int_stack_destroy(first);
+                int_stack_destroy(second);
+                break;
+            }
+            case 25: {
+                size_t size = input_index(&input, model.size + 1);
+                int_stack_truncate(stack, size);
+                model.size = size;
+                break;
+            }
+        }
+
+        check_equal(stack, model.values, model.size);
+        assert(int_stack_len(stack) == model.size);
+        assert(int_stack_is_empty(stack) == !model.size);
+    }
+
+    int_stack_destroy(stack);
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+    run(data, size);
+    return 0;
+}
+
+#ifdef FUZZ_STANDALONE
+int main(int argc, char* argv[]) {
+    if (argc > 1) {
+        for (int i = 1; i < argc; i++) {
+            FILE* file = strcmp(argv[i], "-") ? fopen(argv[i], "rb") : stdin;
+            if (!file) {
+                perror(argv[i]);
+                return 1;
+            }
+            static uint8_t data[1 << 20];
+            size_t size = fread(data, 1, sizeof(data), file);
+            if (file != stdin) {
+                fclose(file);
+            }
+            run(data, size);
+        }
+        return 0;
+    }
+
+    size_t iterations = getenv("FUZZ_ITERATIONS") ? strtoul(getenv("FUZZ_ITERATIONS"), NULL, 10) : 10000;
+    uint64_t seed = getenv("FUZZ_SEED") ? strtoull(getenv("FUZZ_SEED"), NULL, 10) : 1;
+    uint8_t data[4096];
+    printf("running %zu random input%s ... ", iterations, iterations > 1 ? "s" : "");
+    fflush(stdout);
+    for (size_t i = 0; i < iterations; i++) {
+        size_t size = 0;
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        size_t limit = (seed >> 33) % sizeof(data);
+        while (size < limit) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            data[size++] = seed >> 56;
+        }
+        run(data, size);
+    }
+    printf("ok.\n");
+    return 0;
+}
+#endif
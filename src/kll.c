@@ -0,0 +1,156 @@
+#include "kll.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+int_kll_t* int_kll_create(size_t k) {
+    assert(k >= 8);
+    int_kll_t* sketch = malloc(sizeof(int_kll_t));
+
+    sketch->levels = malloc(sizeof(int_stack_t*));
+    sketch->levels[0] = int_stack_with_capacity(k);
+    sketch->height = 1;
+    sketch->k = k;
+    sketch->count = 0;
+    sketch->retained = 0;
+    sketch->capacity = k;
+    sketch->seed = 0x9e3779b97f4a7c15ULL;
+
+    return sketch;
+}
+
+void int_kll_destroy(int_kll_t* sketch) {
+    assert(sketch);
+    for (size_t h = 0; h < sketch->height; h++) {
+        int_stack_destroy(sketch->levels[h]);
+    }
+    free(sketch->levels);
+    free(sketch);
+}
+
+size_t int_kll_len(int_kll_t* sketch) {
+    assert(sketch);
+    return sketch->count;
+}
+
+// Levels shrink geometrically by 2/3 going down from the top level, which always holds k items.
+size_t int_kll_level_capacity(int_kll_t* sketch, size_t level) {
+    size_t capacity = sketch->k;
+    for (size_t depth = sketch->height - 1 - level; depth > 0 && capacity > 2; depth--) {
+        capacity = capacity * 2 / 3;
+    }
+    return capacity > 2 ? capacity : 2;
+}
+
+void int_kll_grow(int_kll_t* sketch) {
+    sketch->levels = realloc(sketch->levels, sizeof(int_stack_t*) * (sketch->height + 1));
+    sketch->levels[sketch->height++] = int_stack_with_capacity(sketch->k);
+
+    sketch->capacity = 0;
+    for (size_t h = 0; h < sketch->height; h++) {
+        sketch->capacity += int_kll_level_capacity(sketch, h);
+    }
+}
+
+int int_kll_coin(int_kll_t* sketch) {
+    sketch->seed ^= sketch->seed << 13;
+    sketch->seed ^= sketch->seed >> 7;
+    sketch->seed ^= sketch->seed << 17;
+    return sketch->seed & 1;
+}
+
+// Compacts the lowest full level by sorting it and promoting every other element, chosen from a random offset, to the
+// level above with twice the weight. An odd element out stays behind so the total weight is preserved.
+void int_kll_compress(int_kll_t* sketch) {
+    for (size_t h = 0; h < sketch->height; h++) {
+        int_stack_t* level = sketch->levels[h];
+        if (level->size < int_kll_level_capacity(sketch, h)) {
+            continue;
+        }
+        if (h + 1 == sketch->height) {
+            int_kll_grow(sketch);
+        }
+        int_stack_t* above = sketch->levels[h + 1];
+
+        int_stack_sort(level);
+        size_t start = level->size % 2;
+        for (size_t i = start + int_kll_coin(sketch); i < level->size; i += 2) {
+            int_stack_push(above, int_stack_get(level, i));
+        }
+        sketch->retained -= (level->size - start) / 2;
+        int_stack_truncate(level, start);
+        return;
+    }
+}
+
+void int_kll_push(int_kll_t* sketch, int value) {
+    assert(sketch);
+    int_stack_push(sketch->levels[0], value);
+    sketch->count++;
+    sketch->retained++;
+    if (sketch->retained >= sketch->capacity) {
+        int_kll_compress(sketch);
+    }
+}
+
+void int_kll_push_stack(int_kll_t* sketch, int_stack_t* stack) {
+    assert(sketch && stack);
+    for (size_t i = 0; i < stack->size; i++) {
+        int_kll_push(sketch, int_stack_get(stack, i));
+    }
+}
+
+size_t int_kll_rank(int_kll_t* sketch, int value) {
+    assert(sketch);
+    size_t rank = 0;
+    for (size_t h = 0; h < sketch->height; h++) {
+        int_stack_t* level = sketch->levels[h];
+        for (size_t i = 0; i < level->size; i++) {
+            if (int_stack_get(level, i) <= value) {
+                rank += (size_t)1 << h;
+            }
+        }
+    }
+    return rank;
+}
+
+typedef struct {
+    int value;
+    size_t weight;
+} int_kll_item_t;
+
+int int_kll_item_cmp(const void* a, const void* b) {
+    int x = ((const int_kll_item_t*)a)->value;
+    int y = ((const int_kll_item_t*)b)->value;
+    return (x > y) - (x < y);
+}
+
+int int_kll_quantile(int_kll_t* sketch, double quantile) {
+    assert(sketch && sketch->count && quantile >= 0 && quantile <= 1);
+    int_kll_item_t* items = malloc(sizeof(int_kll_item_t) * sketch->retained);
+
+    size_t size = 0;
+    for (size_t h = 0; h < sketch->height; h++) {
+        int_stack_t* level = sketch->levels[h];
+        for (size_t i = 0; i < level->size; i++) {
+            items[size].value = int_stack_get(level, i);
+            items[size].weight = (size_t)1 << h;
+            size++;
+        }
+    }
+    qsort(items, size, sizeof(int_kll_item_t), int_kll_item_cmp);
+
+    double target = quantile * sketch->count;
+    size_t cumulative = 0;
+    int value = items[size - 1].value;
+    for (size_t i = 0; i < size; i++) {
+        cumulative += items[i].weight;
+        if (cumulative >= target) {
+            value = items[i].value;
+            break;
+        }
+    }
+
+    free(items);
+    return value;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "stack.h"
+
+#include <stdlib.h>
+
+/// @brief A streaming quantile sketch of integers (KLL). Values are pushed one by one, and approximate ranks and quantiles can be queried at any time using memory proportional to k.
+typedef struct {
+    int_stack_t** levels;
+    size_t height;
+    size_t k;
+    size_t count;
+    size_t retained;
+    size_t capacity;
+    unsigned long long seed;
+} int_kll_t;
+
+/// @brief Create a new sketch. The rank error is roughly 1.7 / k of the amount of pushed values.
+/// @param k Accuracy parameter, at least 8. 200 is a reasonable default.
+/// @return A pointer to the newly created sketch.
+int_kll_t* int_kll_create(size_t k);
+
+/// @brief Free the memory of an existing sketch.
+/// @param sketch The sketch to destroy.
+void int_kll_destroy(int_kll_t* sketch);
+
+/// @brief Get the amount of values pushed into the sketch.
+/// @param sketch The sketch.
+/// @return Amount of pushed values.
+size_t int_kll_len(int_kll_t* sketch);
+
+/// @brief Push a value into the sketch.
+/// @param sketch The sketch.
+/// @param value Value to push.
+void int_kll_push(int_kll_t* sketch, int value);
+
+/// @brief Push every value of a stack into the sketch.
+/// @param sketch The sketch.
+/// @param stack Stack containing the values to push.
+void int_kll_push_stack(int_kll_t* sketch, int_stack_t* stack);
+
+/// @brief Estimate the amount of pushed values which are less than or equal to value.
+/// @param sketch The sketch.
+/// @param value Value to rank.
+/// @return Approximate rank of the value.
+size_t int_kll_rank(int_kll_t* sketch, int value);
+
+/// @brief Estimate the value at the given quantile of the pushed values.
+/// @param sketch The sketch. Must not be empty.
+/// @param quantile Quantile between 0 and 1, e.g. 0.5 for the median.
+/// @return Approximate value at the quantile.
+int int_kll_quantile(int_kll_t* sketch, double quantile);
@@ -5,6 +5,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#ifdef __SSE2__
+    #include <emmintrin.h>
+#endif
+
 int_stack_t* int_stack_create() {
     return int_stack_with_capacity(32);
 }
@@ -29,7 +33,7 @@ int_stack_t* int_stack_from(int array[], size_t size) {
 }
 
 void int_stack_destroy(int_stack_t* stack) {
-    assert(stack && stack->buffer);
+    assert(stack);
     free(stack->buffer);
     free(stack);
 }
@@ -53,7 +57,7 @@ void int_stack_reserve(int_stack_t* stack, size_t amount) {
     assert(stack);
     int alloc = 0;
     while ((stack->capacity - stack->size) < amount) {
-        stack->capacity *= 2;
+        stack->capacity = stack->capacity ? stack->capacity * 2 : 1;
         alloc = 1;
     }
     if (alloc) {
@@ -62,7 +66,7 @@ void int_stack_reserve(int_stack_t* stack, size_t amount) {
 }
 
 int int_stack_get(int_stack_t* stack, size_t index) {
-    // assert(stack && index < stack->size);
+    assert(stack && index < stack->size);
     return *(stack->buffer + index);
 }
 
@@ -76,13 +80,16 @@ int int_stack_first(int_stack_t* stack) {
 }
 
 int int_stack_last(int_stack_t* stack) {
-    return int_stack_get(stack, stack->size);
+    assert(stack && stack->size != 0);
+    return int_stack_get(stack, stack->size - 1);
 }
 
 int int_stack_pop(int_stack_t* stack) {
     assert(stack && stack->size != 0);
 
-    return int_stack_get(stack, --stack->size);
+    int value = int_stack_get(stack, stack->size - 1);
+    stack->size--;
+    return value;
 }
 
 void int_stack_push(int_stack_t* stack, int value) {
@@ -114,18 +121,186 @@ void int_stack_insert(int_stack_t* stack, size_t index, int value) {
 }
 
 int_stack_t* int_stack_slice(int_stack_t* stack, size_t start, size_t stop) {
-    assert(stack && stop < stack->size && stop >= start);
+    assert(stack && stop <= stack->size && stop >= start);
     return int_stack_from(stack->buffer + start, stop - start);
 }
 
 int int_stack_sort_cmp(const void* a, const void* b) {
-    return *(int*)a - *(int*)b;
+    int x = *(const int*)a;
+    int y = *(const int*)b;
+    return (x > y) - (x < y);
 }
 void int_stack_sort(int_stack_t* stack) {
     assert(stack);
     qsort(stack->buffer, stack->size, sizeof(int), int_stack_sort_cmp);
 }
 
+int int_stack_heap_before(int a, int b, int min) {
+    return min ? a < b : a > b;
+}
+
+void int_stack_heap_sift_down(int* heap, size_t size, size_t index, int min) {
+    for (;;) {
+        size_t top = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < size && int_stack_heap_before(heap[left], heap[top], min)) {
+            top = left;
+        }
+        if (right < size && int_stack_heap_before(heap[right], heap[top], min)) {
+            top = right;
+        }
+        if (top == index) {
+            return;
+        }
+        int tmp = heap[index];
+        heap[index] = heap[top];
+        heap[top] = tmp;
+        index = top;
+    }
+}
+
+void int_stack_heap_sift_up(int* heap, size_t index, int min) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!int_stack_heap_before(heap[index], heap[parent], min)) {
+            return;
+        }
+        int tmp = heap[index];
+        heap[index] = heap[parent];
+        heap[parent] = tmp;
+        index = parent;
+    }
+}
+
+void int_stack_heapify(int* heap, size_t size, int min) {
+    for (size_t i = size / 2; i-- > 0;) {
+        int_stack_heap_sift_down(heap, size, i, min);
+    }
+}
+
+// Sorts a heap in-place by repeatedly moving the root to the end. A max-heap ends up ascending, a min-heap descending.
+void int_stack_heap_sort(int* heap, size_t size, int min) {
+    while (size > 1) {
+        size--;
+        int tmp = heap[0];
+        heap[0] = heap[size];
+        heap[size] = tmp;
+        int_stack_heap_sift_down(heap, size, 0, min);
+    }
+}
+
+int int_stack_median_of_three(int a, int b, int c) {
+    if (a < b) {
+        return b < c ? b : (a < c ? c : a);
+    }
+    return a < c ? a : (b < c ? c : b);
+}
+
+// Selects like int_stack_nth_element, partitioning at most depth times before heapsorting the remaining range.
+int int_stack_introselect(int_stack_t* stack, size_t n, size_t depth) {
+    assert(stack && n < stack->size);
+    int* buffer = stack->buffer;
+    size_t lo = 0;
+    size_t hi = stack->size;
+
+    // quickselect with a three-way partition, falling back to heapsort when the pivots keep turning out badly
+    while (hi - lo > 16) {
+        if (depth-- == 0) {
+            int_stack_heapify(buffer + lo, hi - lo, 0);
+            int_stack_heap_sort(buffer + lo, hi - lo, 0);
+            return buffer[n];
+        }
+
+        int pivot = int_stack_median_of_three(buffer[lo], buffer[lo + (hi - lo) / 2], buffer[hi - 1]);
+        size_t lt = lo;
+        size_t gt = hi;
+        size_t i = lo;
+        while (i < gt) {
+            int value = buffer[i];
+            if (value < pivot) {
+                buffer[i++] = buffer[lt];
+                buffer[lt++] = value;
+            } else if (value > pivot) {
+                buffer[i] = buffer[--gt];
+                buffer[gt] = value;
+            } else {
+                i++;
+            }
+        }
+
+        if (n < lt) {
+            hi = lt;
+        } else if (n >= gt) {
+            lo = gt;
+        } else {
+            return buffer[n];
+        }
+    }
+
+    for (size_t i = lo + 1; i < hi; i++) {
+        int value = buffer[i];
+        size_t j = i;
+        while (j > lo && buffer[j - 1] > value) {
+            buffer[j] = buffer[j - 1];
+            j--;
+        }
+        buffer[j] = value;
+    }
+    return buffer[n];
+}
+
+int int_stack_nth_element(int_stack_t* stack, size_t n) {
+    assert(stack);
+    size_t depth = 0;
+    for (size_t i = stack->size; i > 1; i >>= 1) {
+        depth += 2;
+    }
+    return int_stack_introselect(stack, n, depth);
+}
+
+void int_stack_partial_sort(int_stack_t* stack, size_t k) {
+    assert(stack);
+    int* buffer = stack->buffer;
+    if (k > stack->size) {
+        k = stack->size;
+    }
+
+    // keep the k smallest elements seen so far in a max-heap at the front of the stack
+    int_stack_heapify(buffer, k, 0);
+    for (size_t i = k; i < stack->size; i++) {
+        if (k && buffer[i] < buffer[0]) {
+            int tmp = buffer[0];
+            buffer[0] = buffer[i];
+            buffer[i] = tmp;
+            int_stack_heap_sift_down(buffer, k, 0, 0);
+        }
+    }
+    int_stack_heap_sort(buffer, k, 0);
+}
+
+int_stack_t* int_stack_top_k(int_stack_t* stack, size_t k) {
+    assert(stack);
+    if (k > stack->size) {
+        k = stack->size;
+    }
+    int_stack_t* top = int_stack_with_capacity(k ? k : 1);
+
+    // keep the k largest elements seen so far in a min-heap
+    for (size_t i = 0; i < stack->size && k; i++) {
+        int value = stack->buffer[i];
+        if (top->size < k) {
+            top->buffer[top->size++] = value;
+            int_stack_heap_sift_up(top->buffer, top->size - 1, 1);
+        } else if (value > top->buffer[0]) {
+            top->buffer[0] = value;
+            int_stack_heap_sift_down(top->buffer, top->size, 0, 1);
+        }
+    }
+    int_stack_heap_sort(top->buffer, top->size, 1);
+    return top;
+}
+
 int int_stack_contains(int_stack_t* stack, int value) {
     assert(stack);
     for (size_t i = 0; i < stack->size; i++) {
@@ -137,9 +312,260 @@ int int_stack_contains(int_stack_t* stack, int value) {
 }
 
 size_t int_stack_search(int_stack_t* stack, int value) {
-    (void)stack;
-    (void)value;
-    return 0;
+    assert(stack);
+    size_t lo = 0;
+    size_t hi = stack->size;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (stack->buffer[mid] < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo < stack->size && stack->buffer[lo] == value) {
+        return lo;
+    }
+    return (size_t)-1;
+}
+
+void int_stack_dedup(int_stack_t* stack) {
+    assert(stack);
+    if (stack->size < 2) {
+        return;
+    }
+    size_t size = 1;
+    for (size_t i = 1; i < stack->size; i++) {
+        if (stack->buffer[i] != stack->buffer[size - 1]) {
+            stack->buffer[size++] = stack->buffer[i];
+        }
+    }
+    stack->size = size;
+}
+
+// Pushes the value unless it equals the current top of the stack, which keeps sorted output free of duplicates.
+void int_stack_push_distinct(int_stack_t* stack, int value) {
+    if (!stack->size || stack->buffer[stack->size - 1] != value) {
+        int_stack_push(stack, value);
+    }
+}
+
+// Finds the first index at or after start whose element is not less than value, by doubling the step size before
+// binary searching. This costs O(log d) where d is the distance travelled, instead of O(d) for a linear scan.
+size_t int_stack_gallop(const int* buffer, size_t size, size_t start, int value) {
+    if (start >= size || buffer[start] >= value) {
+        return start;
+    }
+    size_t lo = start;
+    size_t step = 1;
+    while (lo + step < size && buffer[lo + step] < value) {
+        lo += step;
+        step *= 2;
+    }
+    size_t hi = lo + step < size ? lo + step : size;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (buffer[mid] < value) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return hi;
+}
+
+int_stack_t* int_stack_merge(int_stack_t* stack, int_stack_t* other) {
+    assert(stack && other);
+    int_stack_t* merged = int_stack_with_capacity(stack->size + other->size + 1);
+    size_t i = 0;
+    size_t j = 0;
+    while (i < stack->size && j < other->size) {
+        if (other->buffer[j] < stack->buffer[i]) {
+            merged->buffer[merged->size++] = other->buffer[j++];
+        } else {
+            merged->buffer[merged->size++] = stack->buffer[i++];
+        }
+    }
+    memcpy(merged->buffer + merged->size, stack->buffer + i, sizeof(int) * (stack->size - i));
+    merged->size += stack->size - i;
+    memcpy(merged->buffer + merged->size, other->buffer + j, sizeof(int) * (other->size - j));
+    merged->size += other->size - j;
+    return merged;
+}
+
+int_stack_t* int_stack_union(int_stack_t* stack, int_stack_t* other) {
+    assert(stack && other);
+    int_stack_t* merged = int_stack_merge(stack, other);
+    int_stack_dedup(merged);
+    return merged;
+}
+
+int_stack_t* int_stack_intersection_gallop(int_stack_t* small, int_stack_t* large) {
+    int_stack_t* result = int_stack_with_capacity(small->size + 1);
+    size_t j = 0;
+    for (size_t i = 0; i < small->size && j < large->size; i++) {
+        int value = small->buffer[i];
+        j = int_stack_gallop(large->buffer, large->size, j, value);
+        if (j < large->size && large->buffer[j] == value) {
+            int_stack_push_distinct(result, value);
+        }
+    }
+    return result;
+}
+
+int_stack_t* int_stack_intersection(int_stack_t* stack, int_stack_t* other) {
+    assert(stack && other);
+    if (stack->size * 32 < other->size) {
+        return int_stack_intersection_gallop(stack, other);
+    }
+    if (other->size * 32 < stack->size) {
+        return int_stack_intersection_gallop(other, stack);
+    }
+
+    int_stack_t* result = int_stack_with_capacity((stack->size < other->size ? stack->size : other->size) + 1);
+    const int* a = stack->buffer;
+    const int* b = other->buffer;
+    size_t i = 0;
+    size_t j = 0;
+
+#ifdef __SSE2__
+    // compare blocks of four elements all-against-all by rotating one block three times, then advance whichever block
+    // ends on the smaller value
+    while (i + 4 <= stack->size && j + 4 <= other->size) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i eq = _mm_cmpeq_epi32(va, vb);
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(0, 3, 2, 1))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(1, 0, 3, 2))));
+        eq = _mm_or_si128(eq, _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, _MM_SHUFFLE(2, 1, 0, 3))));
+
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        for (int k = 0; mask; k++, mask >>= 1) {
+            if (mask & 1) {
+                int_stack_push_distinct(result, a[i + k]);
+            }
+        }
+
+        int a_max = a[i + 3];
+        int b_max = b[j + 3];
+        if (a_max <= b_max) {
+            i += 4;
+        }
+        if (b_max <= a_max) {
+            j += 4;
+        }
+    }
+#endif
+
+    while (i < stack->size && j < other->size) {
+        if (a[i] < b[j]) {
+            i++;
+        } else if (b[j] < a[i]) {
+            j++;
+        } else {
+            int_stack_push_distinct(result, a[i]);
+            i++;
+            j++;
+        }
+    }
+    return result;
+}
+
+int_stack_t* int_stack_difference(int_stack_t* stack, int_stack_t* other) {
+    assert(stack && other);
+    int_stack_t* result = int_stack_with_capacity(stack->size + 1);
+    int gallop = stack->size * 32 < other->size;
+    size_t j = 0;
+    for (size_t i = 0; i < stack->size; i++) {
+        int value = stack->buffer[i];
+        if (gallop) {
+            j = int_stack_gallop(other->buffer, other->size, j, value);
+        } else {
+            while (j < other->size && other->buffer[j] < value) {
+                j++;
+            }
+        }
+        if (j == other->size || other->buffer[j] != value) {
+            int_stack_push_distinct(result, value);
+        }
+    }
+    return result;
+}
+
+// Returns true if the head of stack x should be output before the head of stack y. Exhausted stacks lose every game.
+int int_stack_loser_before(int_stack_t* stacks[], size_t* positions, size_t x, size_t y) {
+    if (positions[x] == stacks[x]->size) {
+        return 0;
+    }
+    if (positions[y] == stacks[y]->size) {
+        return 1;
+    }
+    int a = stacks[x]->buffer[positions[x]];
+    int b = stacks[y]->buffer[positions[y]];
+    return a < b || (a == b && x < y);
+}
+
+// Plays the initial tournament for the subtree rooted at node, storing the loser of each game and returning the winner.
+size_t int_stack_loser_build(int_stack_t* stacks[], size_t* positions, size_t* tree, size_t count, size_t node) {
+    if (node >= count) {
+        return node - count;
+    }
+    size_t left = int_stack_loser_build(stacks, positions, tree, count, 2 * node);
+    size_t right = int_stack_loser_build(stacks, positions, tree, count, 2 * node + 1);
+    if (int_stack_loser_before(stacks, positions, left, right)) {
+        tree[node] = right;
+        return left;
+    }
+    tree[node] = left;
+    return right;
+}
+
+int_stack_t* int_stack_merge_k_impl(int_stack_t* stacks[], size_t count, int distinct) {
+    assert(stacks || !count);
+    size_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        assert(stacks[i]);
+        total += stacks[i]->size;
+    }
+    int_stack_t* merged = int_stack_with_capacity(total + 1);
+    if (!count) {
+        return merged;
+    }
+
+    // leaves are the stacks at implicit nodes count..2*count-1, internal nodes 1..count-1 hold the loser of their game
+    size_t* positions = calloc(count, sizeof(size_t));
+    size_t* tree = malloc(sizeof(size_t) * count);
+    size_t winner = int_stack_loser_build(stacks, positions, tree, count, 1);
+
+    while (positions[winner] < stacks[winner]->size) {
+        int value = stacks[winner]->buffer[positions[winner]++];
+        if (distinct) {
+            int_stack_push_distinct(merged, value);
+        } else {
+            merged->buffer[merged->size++] = value;
+        }
+
+        // only the games on the path from the winner's leaf to the root need to be replayed
+        for (size_t node = (winner + count) / 2; node > 0; node /= 2) {
+            if (int_stack_loser_before(stacks, positions, tree[node], winner)) {
+                size_t tmp = tree[node];
+                tree[node] = winner;
+                winner = tmp;
+            }
+        }
+    }
+
+    free(positions);
+    free(tree);
+    return merged;
+}
+
+int_stack_t* int_stack_merge_k(int_stack_t* stacks[], size_t count) {
+    return int_stack_merge_k_impl(stacks, count, 0);
+}
+
+int_stack_t* int_stack_union_k(int_stack_t* stacks[], size_t count) {
+    return int_stack_merge_k_impl(stacks, count, 1);
 }
 
 void int_stack_swap(int_stack_t* stack, size_t first, size_t second) {
@@ -151,6 +577,9 @@ void int_stack_swap(int_stack_t* stack, size_t first, size_t second) {
 
 void int_stack_reverse(int_stack_t* stack) {
     assert(stack);
+    if (stack->size < 2) {
+        return;
+    }
     size_t l = 0;
     size_t r = stack->size - 1;
     while (l < r) {
@@ -160,6 +589,33 @@ void int_stack_reverse(int_stack_t* stack) {
     }
 }
 
+void int_stack_reverse_range(int* buffer, size_t start, size_t stop) {
+    while (start + 1 < stop) {
+        int tmp = buffer[start];
+        buffer[start++] = buffer[--stop];
+        buffer[stop] = tmp;
+    }
+}
+
+void int_stack_rotate_left(int_stack_t* stack, size_t amount) {
+    assert(stack);
+    if (stack->size < 2) {
+        return;
+    }
+    amount %= stack->size;
+    int_stack_reverse_range(stack->buffer, 0, amount);
+    int_stack_reverse_range(stack->buffer, amount, stack->size);
+    int_stack_reverse_range(stack->buffer, 0, stack->size);
+}
+
+void int_stack_rotate_right(int_stack_t* stack, size_t amount) {
+    assert(stack);
+    if (stack->size < 2) {
+        return;
+    }
+    int_stack_rotate_left(stack, stack->size - amount % stack->size);
+}
+
 void int_stack_append(int_stack_t* stack, int_stack_t* other) {
     assert(stack && other);
     int_stack_reserve(stack, other->size);
@@ -177,13 +633,13 @@ int_stack_t* int_stack_split(int_stack_t* stack, size_t index) {
 
 void int_stack_fill(int_stack_t* stack, int filler) {
     assert(stack);
-    for (size_t i = 0; i < stack->capacity; i++) {
+    while (stack->size < stack->capacity) {
         int_stack_push(stack, filler);
     }
 }
 
 void int_stack_truncate(int_stack_t* stack, size_t size) {
-    assert(stack);
+    assert(stack && size <= stack->size);
     stack->size = size;
 }
 
@@ -207,11 +663,13 @@ void int_stack_map(int_stack_t* stack, int_stack_map_fn map_fn) {
 
 void int_stack_filter(int_stack_t* stack, int_stack_filter_fn filter_fn) {
     assert(stack && filter_fn);
+    size_t size = 0;
     for (size_t i = 0; i < stack->size; i++) {
-        if (!filter_fn(int_stack_get(stack, i))) {
-            int_stack_remove(stack, i);
+        if (filter_fn(int_stack_get(stack, i))) {
+            stack->buffer[size++] = stack->buffer[i];
         }
     }
+    stack->size = size;
 }
 
 int* int_stack_find(int_stack_t* stack, int_stack_filter_fn filter_fn) {
@@ -224,6 +682,20 @@ int* int_stack_find(int_stack_t* stack, int_stack_filter_fn filter_fn) {
     return NULL;
 }
 
+size_t int_stack_partition(int_stack_t* stack, int_stack_filter_fn filter_fn) {
+    assert(stack && filter_fn);
+    size_t l = 0;
+    size_t r = stack->size;
+    while (l < r) {
+        if (filter_fn(stack->buffer[l])) {
+            l++;
+        } else {
+            int_stack_swap(stack, l, --r);
+        }
+    }
+    return l;
+}
+
 int int_stack_fold(int_stack_t* stack, int initial, int_stack_fold_fn fold_fn) {
     assert(stack && fold_fn);
     for (size_t i = 0; i < stack->size; i++) {
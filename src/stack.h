@@ -1,3 +1,5 @@
+#pragma once
+
 #include <stdlib.h>
 
 /// @brief A stack containing integers. The stack will only every grow in size.
@@ -101,6 +103,23 @@ int_stack_t* int_stack_slice(int_stack_t* stack, size_t start, size_t stop);
 /// @param stack The stack.
 void int_stack_sort(int_stack_t* stack);
 
+/// @brief Reorder the stack so the element at index n is the one that would be there if the stack was sorted. Elements before it are not greater, and elements after it are not less. Uses introselect.
+/// @param stack The stack.
+/// @param n Index of the element to select.
+/// @return Value of the selected element.
+int int_stack_nth_element(int_stack_t* stack, size_t n);
+
+/// @brief Reorder the stack so the first k elements are the k smallest elements in sorted order. The order of the remaining elements is unspecified.
+/// @param stack The stack.
+/// @param k Amount of elements to sort. If k is greater than the size of the stack, the whole stack is sorted.
+void int_stack_partial_sort(int_stack_t* stack, size_t k);
+
+/// @brief Collect the k largest elements of the stack using a bounded heap. The stack is not modified.
+/// @param stack The stack.
+/// @param k Amount of elements to collect.
+/// @return A new stack containing the k largest elements in descending order. If k is greater than the size of the stack, it contains every element.
+int_stack_t* int_stack_top_k(int_stack_t* stack, size_t k);
+
 /// @brief Searches the stack linearly for the value and returns true if any element matches the value.
 /// @param stack The stack.
 /// @param value Value to match.
@@ -113,12 +132,52 @@ int int_stack_contains(int_stack_t* stack, int value);
 /// @return Index of the value, or -1 if value was not found.
 size_t int_stack_search(int_stack_t* stack, int value);
 
+/// @brief Remove consecutive duplicate elements in-place. On a sorted stack this leaves every value exactly once.
+/// @param stack The stack.
+void int_stack_dedup(int_stack_t* stack);
+
+/// @brief Merge two sorted stacks into a new sorted stack, keeping duplicates.
+/// @param stack A sorted stack.
+/// @param other A sorted stack.
+/// @return A new stack containing every element of both stacks.
+int_stack_t* int_stack_merge(int_stack_t* stack, int_stack_t* other);
+
+/// @brief Compute the union of two sorted stacks.
+/// @param stack A sorted stack.
+/// @param other A sorted stack.
+/// @return A new sorted stack containing every value found in either stack exactly once.
+int_stack_t* int_stack_union(int_stack_t* stack, int_stack_t* other);
+
+/// @brief Compute the intersection of two sorted stacks. Uses SIMD block comparisons for similarly sized stacks and galloping search when one is much smaller.
+/// @param stack A sorted stack.
+/// @param other A sorted stack.
+/// @return A new sorted stack containing every value found in both stacks exactly once.
+int_stack_t* int_stack_intersection(int_stack_t* stack, int_stack_t* other);
+
+/// @brief Compute the difference of two sorted stacks.
+/// @param stack A sorted stack.
+/// @param other A sorted stack.
+/// @return A new sorted stack containing every value found in stack but not in other exactly once.
+int_stack_t* int_stack_difference(int_stack_t* stack, int_stack_t* other);
+
+/// @brief Merge any amount of sorted stacks into a new sorted stack using a loser tree, keeping duplicates.
+/// @param stacks Array of sorted stacks.
+/// @param count Amount of stacks.
+/// @return A new stack containing every element of all the stacks.
+int_stack_t* int_stack_merge_k(int_stack_t* stacks[], size_t count);
+
+/// @brief Compute the union of any amount of sorted stacks using a loser tree.
+/// @param stacks Array of sorted stacks.
+/// @param count Amount of stacks.
+/// @return A new sorted stack containing every value found in any of the stacks exactly once.
+int_stack_t* int_stack_union_k(int_stack_t* stacks[], size_t count);
+
 /// @brief Rotate the elements in the stack left.
 /// @param stack The stack.
 /// @param amount Amount of times to rotate.
 void int_stack_rotate_left(int_stack_t* stack, size_t amount);
 
-/// @brief Rotate the elements in the stack right.,
+/// @brief Rotate the elements in the stack right.
 /// @param stack The stack.
 /// @param amount Amount of times to rotate.
 void int_stack_rotate_right(int_stack_t* stack, size_t amount);
@@ -144,7 +203,7 @@ void int_stack_append(int_stack_t* stack, int_stack_t* other);
 /// @return A pointer to a new stack containing the remaining elements.
 int_stack_t* int_stack_split(int_stack_t* stack, size_t index);
 
-/// @brief Fills the stack with filler elements.
+/// @brief Fills the remaining capacity of the stack with filler elements.
 /// @param stack The stack.
 /// @param filler Filler value.
 void int_stack_fill(int_stack_t* stack, int filler);
@@ -180,6 +239,12 @@ void int_stack_filter(int_stack_t* stack, int_stack_filter_fn filter_fn);
 /// @return Pointer to the first value that satisfies the filter function. NULL no element matched the predicate.
 int* int_stack_find(int_stack_t* stack, int_stack_filter_fn filter_fn);
 
+/// @brief Reorder the stack so every element matching the predicate comes before every element which does not. The relative order of elements is not preserved.
+/// @param stack The stack.
+/// @param filter_fn Function which returns true for elements which should be moved to the front.
+/// @return Amount of elements matching the predicate.
+size_t int_stack_partition(int_stack_t* stack, int_stack_filter_fn filter_fn);
+
 /// @brief Reduces every value down to to a single int accumulator.
 /// @param stack The stack.
 /// @param initial Initial value for the accumulator.
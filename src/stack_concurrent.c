@@ -0,0 +1,182 @@
+#include "stack_concurrent.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+int_stack_version_t* int_stack_version_create(size_t capacity) {
+    int_stack_version_t* version = malloc(sizeof(int_stack_version_t) + sizeof(int) * capacity);
+
+    atomic_init(&version->size, 0);
+    version->capacity = capacity;
+    version->retired = 0;
+    version->next = NULL;
+
+    return version;
+}
+
+int_stack_concurrent_t* int_stack_concurrent_create(size_t max_readers) {
+    int_stack_concurrent_t* stack = malloc(sizeof(int_stack_concurrent_t));
+
+    atomic_init(&stack->current, int_stack_version_create(32));
+    atomic_init(&stack->epoch, 1);
+    atomic_init(&stack->registered, 0);
+    stack->max_readers = max_readers;
+    stack->readers = aligned_alloc(_Alignof(int_stack_reader_t), sizeof(int_stack_reader_t) * (max_readers + 1));
+    for (size_t i = 0; i < max_readers; i++) {
+        atomic_init(&stack->readers[i].epoch, 0);
+    }
+    stack->retired = NULL;
+
+    return stack;
+}
+
+void int_stack_concurrent_destroy(int_stack_concurrent_t* stack) {
+    assert(stack);
+    while (stack->retired) {
+        int_stack_version_t* next = stack->retired->next;
+        free(stack->retired);
+        stack->retired = next;
+    }
+    free(atomic_load(&stack->current));
+    free(stack->readers);
+    free(stack);
+}
+
+size_t int_stack_concurrent_register(int_stack_concurrent_t* stack) {
+    assert(stack);
+    size_t reader = atomic_fetch_add(&stack->registered, 1);
+    assert(reader < stack->max_readers);
+    return reader;
+}
+
+// Advances the global epoch if every active reader has observed it, then frees the versions that were retired at
+// least two epochs ago. A reader can only hold a version that was current when it announced its epoch, so such
+// versions are no longer reachable.
+void int_stack_concurrent_reclaim(int_stack_concurrent_t* stack) {
+    size_t epoch = atomic_load(&stack->epoch);
+    size_t registered = atomic_load(&stack->registered);
+
+    int advance = 1;
+    for (size_t i = 0; i < registered && i < stack->max_readers; i++) {
+        size_t observed = atomic_load(&stack->readers[i].epoch);
+        if (observed && observed != epoch) {
+            advance = 0;
+            break;
+        }
+    }
+    if (advance) {
+        atomic_store(&stack->epoch, ++epoch);
+    }
+
+    int_stack_version_t** link = &stack->retired;
+    while (*link) {
+        int_stack_version_t* version = *link;
+        if (version->retired + 2 <= epoch) {
+            *link = version->next;
+            free(version);
+        } else {
+            link = &version->next;
+        }
+    }
+}
+
+// Publishes a new version holding the first size elements of the current one and retires the old version.
+int_stack_version_t* int_stack_concurrent_publish(int_stack_concurrent_t* stack, size_t size, size_t capacity) {
+    int_stack_version_t* old = atomic_load_explicit(&stack->current, memory_order_relaxed);
+    int_stack_version_t* version = int_stack_version_create(capacity);
+    memcpy(version->buffer, old->buffer, sizeof(int) * size);
+    atomic_init(&version->size, size);
+    atomic_store(&stack->current, version);
+
+    old->retired = atomic_load(&stack->epoch);
+    old->next = stack->retired;
+    stack->retired = old;
+    int_stack_concurrent_reclaim(stack);
+
+    return version;
+}
+
+// Publishes a new version with room for at least amount additional elements.
+int_stack_version_t* int_stack_concurrent_grow(int_stack_concurrent_t* stack, size_t amount) {
+    int_stack_version_t* version = atomic_load_explicit(&stack->current, memory_order_relaxed);
+    size_t size = atomic_load_explicit(&version->size, memory_order_relaxed);
+
+    size_t capacity = version->capacity;
+    while ((capacity - size) < amount) {
+        capacity *= 2;
+    }
+    return int_stack_concurrent_publish(stack, size, capacity);
+}
+
+void int_stack_concurrent_push(int_stack_concurrent_t* stack, int value) {
+    assert(stack);
+    int_stack_version_t* version = atomic_load_explicit(&stack->current, memory_order_relaxed);
+    size_t size = atomic_load_explicit(&version->size, memory_order_relaxed);
+
+    if (size == version->capacity) {
+        version = int_stack_concurrent_grow(stack, 1);
+    }
+    version->buffer[size] = value;
+    atomic_store_explicit(&version->size, size + 1, memory_order_release);
+}
+
+void int_stack_concurrent_append(int_stack_concurrent_t* stack, int_stack_t* other) {
+    assert(stack && other);
+    int_stack_version_t* version = atomic_load_explicit(&stack->current, memory_order_relaxed);
+    size_t size = atomic_load_explicit(&version->size, memory_order_relaxed);
+
+    if ((version->capacity - size) < other->size) {
+        version = int_stack_concurrent_grow(stack, other->size);
+    }
+    memcpy(version->buffer + size, other->buffer, sizeof(int) * other->size);
+    atomic_store_explicit(&version->size, size + other->size, memory_order_release);
+    other->size = 0;
+}
+
+void int_stack_concurrent_truncate(int_stack_concurrent_t* stack, size_t size) {
+    assert(stack);
+    int_stack_version_t* version = atomic_load_explicit(&stack->current, memory_order_relaxed);
+    assert(size <= atomic_load_explicit(&version->size, memory_order_relaxed));
+    (void)version;
+    int_stack_concurrent_publish(stack, size, size ? size : 1);
+}
+
+int_stack_t int_stack_concurrent_enter(int_stack_concurrent_t* stack, size_t reader) {
+    assert(stack && reader < stack->max_readers);
+    atomic_store(&stack->readers[reader].epoch, atomic_load(&stack->epoch));
+
+    int_stack_version_t* version = atomic_load(&stack->current);
+    int_stack_t view = {
+        .buffer = version->buffer,
+        .capacity = version->capacity,
+        .size = atomic_load_explicit(&version->size, memory_order_acquire)};
+    return view;
+}
+
+void int_stack_concurrent_leave(int_stack_concurrent_t* stack, size_t reader) {
+    assert(stack && reader < stack->max_readers);
+    atomic_store_explicit(&stack->readers[reader].epoch, 0, memory_order_release);
+}
+
+size_t int_stack_concurrent_len(int_stack_concurrent_t* stack, size_t reader) {
+    int_stack_t view = int_stack_concurrent_enter(stack, reader);
+    size_t size = int_stack_len(&view);
+    int_stack_concurrent_leave(stack, reader);
+    return size;
+}
+
+int int_stack_concurrent_contains(int_stack_concurrent_t* stack, size_t reader, int value) {
+    int_stack_t view = int_stack_concurrent_enter(stack, reader);
+    int found = int_stack_contains(&view, value);
+    int_stack_concurrent_leave(stack, reader);
+    return found;
+}
+
+int int_stack_concurrent_fold(int_stack_concurrent_t* stack, size_t reader, int initial, int_stack_fold_fn fold_fn) {
+    int_stack_t view = int_stack_concurrent_enter(stack, reader);
+    int value = int_stack_fold(&view, initial, fold_fn);
+    int_stack_concurrent_leave(stack, reader);
+    return value;
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "stack.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+
+/// @brief An immutable-prefix version of a concurrent stack's buffer. Elements below size are never modified once published.
+typedef struct int_stack_version {
+    _Atomic size_t size;
+    size_t capacity;
+    size_t retired;
+    struct int_stack_version* next;
+    int buffer[];
+} int_stack_version_t;
+
+/// @brief Per-reader epoch announcement, padded to a cache line to avoid false sharing between readers.
+typedef struct {
+    _Alignas(64) _Atomic size_t epoch;
+} int_stack_reader_t;
+
+/// @brief A stack with a single writer and many wait-free readers. The writer publishes new buffer versions atomically, and old versions are reclaimed using epoch-based reclamation.
+typedef struct {
+    _Atomic(int_stack_version_t*) current;
+    _Atomic size_t epoch;
+    _Atomic size_t registered;
+    size_t max_readers;
+    int_stack_reader_t* readers;
+    int_stack_version_t* retired;
+} int_stack_concurrent_t;
+
+/// @brief Create a new concurrent stack. It will have an initial capacity of 32 elements.
+/// @param max_readers Maximum amount of reader threads which may register with the stack.
+/// @return A pointer to the newly created stack.
+int_stack_concurrent_t* int_stack_concurrent_create(size_t max_readers);
+
+/// @brief Free the memory of an existing concurrent stack, including all retired versions. No readers may be active.
+/// @param stack The stack to destroy.
+void int_stack_concurrent_destroy(int_stack_concurrent_t* stack);
+
+/// @brief Register a reader thread with the stack. Each reader thread must use its own id.
+/// @param stack The stack.
+/// @return Reader id to pass to the read functions.
+size_t int_stack_concurrent_register(int_stack_concurrent_t* stack);
+
+/// @brief Get the length/size of the latest published version of the stack.
+/// @param stack The stack.
+/// @param reader Reader id returned by int_stack_concurrent_register.
+/// @return Length of the stack.
+size_t int_stack_concurrent_len(int_stack_concurrent_t* stack, size_t reader);
+
+/// @brief Push an element to the top of the stack. Must only be called from the writer thread.
+/// @param stack The stack.
+/// @param value Value to push.
+void int_stack_concurrent_push(int_stack_concurrent_t* stack, int value);
+
+/// @brief Move all the elements of other into the stack. Must only be called from the writer thread.
+/// @param stack The stack.
+/// @param other Stack which will be emptied.
+void int_stack_concurrent_append(int_stack_concurrent_t* stack, int_stack_t* other);
+
+/// @brief Truncate the stack to desired size, discarding excess elements. A new version with just enough capacity is published, so readers still holding the old version are unaffected. Must only be called from the writer thread.
+/// @param stack The stack.
+/// @param size New size of stack.
+void int_stack_concurrent_truncate(int_stack_concurrent_t* stack, size_t size);
+
+/// @brief Pin the latest version of the stack and get a read-only view of it. The view stays valid until int_stack_concurrent_leave is called, and may be passed to the non-mutating int_stack_* functions.
+/// @param stack The stack.
+/// @param reader Reader id returned by int_stack_concurrent_register.
+/// @return A snapshot view of the stack. It must not be modified or destroyed.
+int_stack_t int_stack_concurrent_enter(int_stack_concurrent_t* stack, size_t reader);
+
+/// @brief Unpin the version pinned by int_stack_concurrent_enter, allowing it to be reclaimed.
+/// @param stack The stack.
+/// @param reader Reader id returned by int_stack_concurrent_register.
+void int_stack_concurrent_leave(int_stack_concurrent_t* stack, size_t reader);
+
+/// @brief Searches a snapshot of the stack linearly for the value and returns true if any element matches the value.
+/// @param stack The stack.
+/// @param reader Reader id returned by int_stack_concurrent_register.
+/// @param value Value to match.
+/// @return True if the value was found.
+int int_stack_concurrent_contains(int_stack_concurrent_t* stack, size_t reader, int value);
+
+/// @brief Reduces every value in a snapshot of the stack down to a single int accumulator.
+/// @param stack The stack.
+/// @param reader Reader id returned by int_stack_concurrent_register.
+/// @param initial Initial value for the accumulator.
+/// @param fold_fn Function which takes an accumulator and an int value and folds the value into the accumulator.
+/// @return Final value of the accumulator.
+int int_stack_concurrent_fold(int_stack_concurrent_t* stack, size_t reader, int initial, int_stack_fold_fn fold_fn);
@@ -1,6 +1,9 @@
+#include "kll.h"
 #include "stack.h"
+#include "stack_concurrent.h"
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
@@ -21,18 +24,26 @@ void test_stack_create();
 void test_stack_conditionals();
 void test_stack_access();
 void test_stack_sort();
+void test_stack_select();
 void test_stack_search();
+void test_stack_sets();
 void test_stack_operations();
 void test_stack_functional();
+void test_stack_concurrent();
+void test_kll();
 
 const testfn tests[] = {
     test_stack_create,
     test_stack_conditionals,
     test_stack_access,
     test_stack_sort,
+    test_stack_select,
     test_stack_search,
+    test_stack_sets,
     test_stack_operations,
-    test_stack_functional};
+    test_stack_functional,
+    test_stack_concurrent,
+    test_kll};
 const size_t len = sizeof(tests) / sizeof(testfn);
 
 /* stack tests */
@@ -100,16 +111,238 @@ void test_stack_sort() {
     int_stack_destroy(stack);
 }
 
-void test_stack_search() {
+// Not part of stack.h. Used to force the heapsort fallback of int_stack_nth_element.
+int int_stack_introselect(int_stack_t* stack, size_t n, size_t depth);
+
+int is_odd(int value) {
+    return value % 2;
+}
+
+void test_stack_select() {
     int_stack_t* stack = int_stack_create();
+    for (int i = 0; i < 1000; i++) {
+        int_stack_push(stack, (i * 7919) % 1000 / 2);
+    }
+
+    assert(int_stack_nth_element(stack, 500) == 250);
+    for (size_t i = 0; i < 500; i++) {
+        assert(int_stack_get(stack, i) <= 250);
+    }
+    for (size_t i = 501; i < 1000; i++) {
+        assert(int_stack_get(stack, i) >= 250);
+    }
+    assert(int_stack_nth_element(stack, 0) == 0);
+    assert(int_stack_nth_element(stack, 999) == 499);
+
+    // with no partitioning rounds left, the heapsort fallback sorts the whole stack
+    int_stack_t* fallback = int_stack_from(stack->buffer, stack->size);
+    int_stack_reverse(fallback);
+    assert(int_stack_introselect(fallback, 300, 0) == 150);
+    for (size_t i = 1; i < fallback->size; i++) {
+        assert(int_stack_get(fallback, i - 1) <= int_stack_get(fallback, i));
+    }
+    int_stack_destroy(fallback);
+
+    // after one round, only the side containing n is heapsorted
+    fallback = int_stack_from(stack->buffer, stack->size);
+    assert(int_stack_introselect(fallback, 700, 1) == 350);
+    for (size_t i = 0; i < fallback->size; i++) {
+        assert(i < 700 ? int_stack_get(fallback, i) <= 350 : int_stack_get(fallback, i) >= 350);
+    }
+    int_stack_destroy(fallback);
+
+    int_stack_t* top = int_stack_top_k(stack, 5);
+    int a[] = {499, 499, 498, 498, 497};
+    assert(top->size == 5);
+    assert(!memcmp(top->buffer, a, sizeof(a)));
+    int_stack_destroy(top);
+
+    int_stack_partial_sort(stack, 5);
+    int b[] = {0, 0, 1, 1, 2};
+    assert(!memcmp(stack->buffer, b, sizeof(b)));
+
+    // k past the size of the stack selects every element
+    int small[] = {3, 1, 2};
+    int_stack_t* few = int_stack_from(small, 3);
+    top = int_stack_top_k(few, (size_t)1 << 62);
+    int descending[] = {3, 2, 1};
+    assert(top->size == 3 && top->capacity == 3 && !memcmp(top->buffer, descending, sizeof(descending)));
+    int_stack_destroy(top);
+    int_stack_partial_sort(few, 100);
+    int ascending[] = {1, 2, 3};
+    assert(few->size == 3 && !memcmp(few->buffer, ascending, sizeof(ascending)));
+    int_stack_destroy(few);
+
+    size_t odd = int_stack_partition(stack, is_odd);
+    assert(odd == 500);
+    for (size_t i = 0; i < stack->size; i++) {
+        assert(is_odd(int_stack_get(stack, i)) == (i < odd));
+    }
 
     int_stack_destroy(stack);
 }
 
-void test_stack_operations() {
+void test_stack_search() {
+    int init[] = {-7, -1, 0, 2, 2, 5, 9};
+    int_stack_t* stack = int_stack_from(init, 7);
+
+    assert(int_stack_search(stack, -7) == 0);
+    assert(int_stack_search(stack, 0) == 2);
+    assert(int_stack_search(stack, 2) == 3);
+    assert(int_stack_search(stack, 9) == 6);
+    assert(int_stack_search(stack, 1) == (size_t)-1);
+    assert(int_stack_search(stack, 10) == (size_t)-1);
+    assert(int_stack_search(stack, -8) == (size_t)-1);
+    assert(int_stack_contains(stack, 5));
+    assert(!int_stack_contains(stack, 6));
+
+    int_stack_t* empty = int_stack_with_capacity(0);
+    assert(int_stack_search(empty, 0) == (size_t)-1);
+    assert(!int_stack_contains(empty, 0));
+
+    int_stack_destroy(stack);
+    int_stack_destroy(empty);
+}
+
+int_stack_t* sorted_stack(size_t size, int modulo, unsigned seed) {
     int_stack_t* stack = int_stack_create();
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        int_stack_push(stack, (int)(seed >> 16) % modulo);
+    }
+    int_stack_sort(stack);
+    return stack;
+}
+
+void test_stack_sets() {
+    int a[] = {1, 2, 2, 3, 5, 8, 8, 13};
+    int b[] = {2, 3, 4, 8, 16};
+    int_stack_t* x = int_stack_from(a, 8);
+    int_stack_t* y = int_stack_from(b, 5);
+
+    int_stack_t* merged = int_stack_merge(x, y);
+    int c[] = {1, 2, 2, 2, 3, 3, 4, 5, 8, 8, 8, 13, 16};
+    assert(merged->size == 13 && !memcmp(merged->buffer, c, sizeof(c)));
+    int_stack_t* united = int_stack_union(x, y);
+    int d[] = {1, 2, 3, 4, 5, 8, 13, 16};
+    assert(united->size == 8 && !memcmp(united->buffer, d, sizeof(d)));
+    int_stack_t* intersected = int_stack_intersection(x, y);
+    int e[] = {2, 3, 8};
+    assert(intersected->size == 3 && !memcmp(intersected->buffer, e, sizeof(e)));
+    int_stack_t* difference = int_stack_difference(x, y);
+    int f[] = {1, 5, 13};
+    assert(difference->size == 3 && !memcmp(difference->buffer, f, sizeof(f)));
+
+    int_stack_t* stacks[] = {x, y, merged};
+    int_stack_t* merged_k = int_stack_merge_k(stacks, 3);
+    assert(merged_k->size == 26);
+    for (size_t i = 1; i < merged_k->size; i++) {
+        assert(int_stack_get(merged_k, i - 1) <= int_stack_get(merged_k, i));
+    }
+    int_stack_t* united_k = int_stack_union_k(stacks, 3);
+    assert(united_k->size == 8 && !memcmp(united_k->buffer, d, sizeof(d)));
+
+    int_stack_dedup(merged);
+    assert(merged->size == 8 && !memcmp(merged->buffer, d, sizeof(d)));
+
+    int_stack_destroy(x);
+    int_stack_destroy(y);
+    int_stack_destroy(merged);
+    int_stack_destroy(united);
+    int_stack_destroy(intersected);
+    int_stack_destroy(difference);
+    int_stack_destroy(merged_k);
+    int_stack_destroy(united_k);
+
+    // check the block and galloping kernels against linear searches for balanced and skewed sizes
+    size_t sizes[][2] = {{1000, 1000}, {997, 1501}, {20, 5000}, {5000, 20}};
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        int_stack_t* p = sorted_stack(sizes[i][0], 3000, i);
+        int_stack_t* q = sorted_stack(sizes[i][1], 3000, i + 100);
+        int_stack_t* both = int_stack_intersection(p, q);
+        int_stack_t* only = int_stack_difference(p, q);
+        for (int v = 0; v < 3000; v++) {
+            int in_p = int_stack_contains(p, v);
+            int in_q = int_stack_contains(q, v);
+            assert(int_stack_contains(both, v) == (in_p && in_q));
+            assert(int_stack_contains(only, v) == (in_p && !in_q));
+        }
+        for (size_t j = 1; j < both->size; j++) {
+            assert(int_stack_get(both, j - 1) < int_stack_get(both, j));
+        }
+        for (size_t j = 1; j < only->size; j++) {
+            assert(int_stack_get(only, j - 1) < int_stack_get(only, j));
+        }
+        int_stack_destroy(p);
+        int_stack_destroy(q);
+        int_stack_destroy(both);
+        int_stack_destroy(only);
+    }
+}
+
+void test_stack_operations() {
+    int_stack_t* stack = int_stack_with_capacity(0);
+    int_stack_push(stack, 3);
+    int_stack_push(stack, 2);
+    int_stack_push(stack, 1);
+    assert(int_stack_first(stack) == 3);
+    assert(int_stack_last(stack) == 1);
+
+    int_stack_reverse(stack);
+    int a[] = {1, 2, 3};
+    assert(!memcmp(stack->buffer, a, sizeof(a)));
+
+    int_stack_rotate_left(stack, 4);
+    int b[] = {2, 3, 1};
+    assert(!memcmp(stack->buffer, b, sizeof(b)));
+    int_stack_rotate_right(stack, 2);
+    int c[] = {3, 1, 2};
+    assert(!memcmp(stack->buffer, c, sizeof(c)));
+
+    int_stack_insert(stack, 1, 7);
+    int_stack_insert(stack, 4, 8);
+    int d[] = {3, 7, 1, 2, 8};
+    assert(stack->size == 5 && !memcmp(stack->buffer, d, sizeof(d)));
+    assert(int_stack_remove(stack, 0) == 3);
+    assert(int_stack_pop(stack) == 8);
+    int e[] = {7, 1, 2};
+    assert(stack->size == 3 && !memcmp(stack->buffer, e, sizeof(e)));
+
+    int_stack_t* split = int_stack_split(stack, 1);
+    assert(stack->size == 1 && split->size == 2);
+    int_stack_append(stack, split);
+    assert(stack->size == 3 && split->size == 0);
+    assert(!memcmp(stack->buffer, e, sizeof(e)));
+
+    int_stack_t* slice = int_stack_slice(stack, 1, 3);
+    assert(slice->size == 2 && !memcmp(slice->buffer, e + 1, sizeof(int) * 2));
+
+    int_stack_resize(stack, 5, 4);
+    int f[] = {7, 1, 2, 4, 4};
+    assert(stack->size == 5 && !memcmp(stack->buffer, f, sizeof(f)));
+    int_stack_resize(stack, 2, 0);
+    assert(stack->size == 2);
+
+    int_stack_fill(stack, 9);
+    assert(int_stack_is_full(stack));
+    assert(int_stack_get(stack, 1) == 1 && int_stack_last(stack) == 9);
+
+    int_stack_t* empty = int_stack_create();
+    int_stack_reverse(empty);
+    int_stack_rotate_left(empty, 3);
+    assert(int_stack_is_empty(empty));
+
+    int g[] = {-2147483647 - 1, 2147483647, 0, -1};
+    int_stack_t* extremes = int_stack_from(g, 4);
+    int_stack_sort(extremes);
+    int h[] = {-2147483647 - 1, -1, 0, 2147483647};
+    assert(!memcmp(extremes->buffer, h, sizeof(h)));
 
     int_stack_destroy(stack);
+    int_stack_destroy(split);
+    int_stack_destroy(slice);
+    int_stack_destroy(empty);
+    int_stack_destroy(extremes);
 }
 
 int triple(int value) {
@@ -139,7 +372,13 @@ void test_stack_functional() {
 
     int_stack_filter(stack, is_even);
     int b[] = {0, 6, 12};
-    assert(!memcmp(stack->buffer, b, sizeof(b)));
+    assert(stack->size == 3 && !memcmp(stack->buffer, b, sizeof(b)));
+
+    int o[] = {0, 3, 5, 6, 9, 11, 12};
+    int_stack_t* odds = int_stack_from(o, 7);
+    int_stack_filter(odds, is_even);
+    assert(odds->size == 3 && !memcmp(odds->buffer, b, sizeof(b)));
+    int_stack_destroy(odds);
 
     int v = int_stack_fold(stack, 0, sum);
     int c = 18;
@@ -148,6 +387,74 @@ void test_stack_functional() {
     int_stack_destroy(stack);
 }
 
+void* concurrent_reader(void* arg) {
+    int_stack_concurrent_t* stack = arg;
+    size_t reader = int_stack_concurrent_register(stack);
+    for (int i = 0; i < 1000; i++) {
+        int_stack_t view = int_stack_concurrent_enter(stack, reader);
+        for (size_t j = 0; j < view.size; j++) {
+            assert(int_stack_get(&view, j) == (int)j);
+        }
+        int_stack_concurrent_leave(stack, reader);
+    }
+    return NULL;
+}
+
+void test_stack_concurrent() {
+    int_stack_concurrent_t* stack = int_stack_concurrent_create(5);
+
+    pthread_t readers[4];
+    for (size_t i = 0; i < 4; i++) {
+        pthread_create(&readers[i], NULL, concurrent_reader, stack);
+    }
+    for (int i = 0; i < 5000; i++) {
+        int_stack_concurrent_push(stack, i);
+    }
+    int rest[] = {5000, 5001, 5002};
+    int_stack_t* other = int_stack_from(rest, 3);
+    int_stack_concurrent_append(stack, other);
+    assert(other->size == 0);
+    for (size_t i = 0; i < 4; i++) {
+        pthread_join(readers[i], NULL);
+    }
+
+    size_t reader = int_stack_concurrent_register(stack);
+    assert(int_stack_concurrent_len(stack, reader) == 5003);
+    assert(int_stack_concurrent_contains(stack, reader, 5002));
+    assert(!int_stack_concurrent_contains(stack, reader, 5003));
+    assert(int_stack_concurrent_fold(stack, reader, 0, sum) == 5003 * 5002 / 2);
+
+    int_stack_t view = int_stack_concurrent_enter(stack, reader);
+    int_stack_concurrent_truncate(stack, 10);
+    int_stack_concurrent_push(stack, -1);
+    assert(view.size == 5003 && int_stack_last(&view) == 5002);
+    int_stack_concurrent_leave(stack, reader);
+    assert(int_stack_concurrent_len(stack, reader) == 11);
+    assert(int_stack_concurrent_contains(stack, reader, -1));
+    assert(!int_stack_concurrent_contains(stack, reader, 10));
+
+    int_stack_destroy(other);
+    int_stack_concurrent_destroy(stack);
+}
+
+void test_kll() {
+    int_kll_t* sketch = int_kll_create(200);
+    for (int i = 0; i < 100000; i++) {
+        int_kll_push(sketch, (int)((i * 7919L) % 100000));
+    }
+    assert(int_kll_len(sketch) == 100000);
+    assert(sketch->retained < 1000);
+
+    int median = int_kll_quantile(sketch, 0.5);
+    assert(median > 48000 && median < 52000);
+    int p99 = int_kll_quantile(sketch, 0.99);
+    assert(p99 > 97000 && p99 < 100000);
+    size_t rank = int_kll_rank(sketch, 25000);
+    assert(rank > 23000 && rank < 27000);
+
+    int_kll_destroy(sketch);
+}
+
 // void test_stack() {
 //     int_stack_t* stack = int_stack_create();
 